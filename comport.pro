@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui serialport
+QT       += core gui serialport network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -24,14 +24,25 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# Hot-path tracing (Chrome trace JSON), build with: qmake CONFIG+=trace
+trace {
+    DEFINES += COMPORT_TRACE
+    SOURCES += tracer.cpp
+}
+
 SOURCES += \
         main.cpp \
         mainwindow.cpp \
+    portbridge.cpp \
+    serialtuning.cpp \
     settingsdialog.cpp
 
 HEADERS += \
         mainwindow.h \
-    settingsdialog.h
+    portbridge.h \
+    serialtuning.h \
+    settingsdialog.h \
+    tracer.h
 
 FORMS += \
         mainwindow.ui \
@@ -1,11 +1,109 @@
 #include "mainwindow.h"
+#include "portbridge.h"
+#include "tracer.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QSerialPort>
+
+// QApplication для --headless не нужен (и может не подняться без дисплея),
+// поэтому флаг проверяем до создания приложения.
+static bool hasArg(int argc, char *argv[], const char *arg)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], arg) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Без окна: порт открывается сразу и раздаётся через мост.
+static bool startHeadless(QCoreApplication *app, const QString &portName, qint32 baudRate, const QString &address)
+{
+    if (portName.isEmpty() || address.isEmpty()) {
+        qCritical("--headless needs --port and --listen");
+        return false;
+    }
+    QSerialPort *serial = new QSerialPort(app);
+    serial->setPortName(portName);
+    serial->setBaudRate(baudRate);
+    if (!serial->open(QIODevice::ReadWrite)) {
+        qCritical("Can't open %s: %s", qPrintable(portName), qPrintable(serial->errorString()));
+        return false;
+    }
+    PortBridge *bridge = new PortBridge(app);
+    if (!bridge->listen(address)) {
+        qCritical("Can't listen on %s: %s", qPrintable(address), qPrintable(bridge->errorString()));
+        return false;
+    }
+    qInfo("%s bridged on %s", qPrintable(portName), qPrintable(bridge->address()));
+    QObject::connect(bridge, &PortBridge::sigClientCountChanged, [] (int count) {
+        qInfo("clients: %d", count);
+    });
+    QObject::connect(serial, &QSerialPort::readyRead, bridge, [=] () { bridge->slBroadcast(serial->readAll()); });
+    QObject::connect(bridge, &PortBridge::sigClientData, serial, [=] (QByteArray data) { serial->write(data); });
+    QObject::connect(serial, &QSerialPort::errorOccurred, app, [=] (QSerialPort::SerialPortError error) {
+        if (error == QSerialPort::ResourceError) {
+            qCritical("%s: %s", qPrintable(portName), qPrintable(serial->errorString()));
+            app->exit(1);
+        }
+    });
+    return true;
+}
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-    MainWindow w;
-    w.show();
+    const bool headless = hasArg(argc, argv, "--headless");
+    QScopedPointer<QCoreApplication> a(headless ? new QCoreApplication(argc, argv)
+                                                : new QApplication(argc, argv));
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption headlessOption("headless",
+            QCoreApplication::translate("main", "Run without window, only the socket bridge."));
+    QCommandLineOption portOption("port",
+            QCoreApplication::translate("main", "Serial port for --headless."), "name");
+    QCommandLineOption baudOption("baud",
+            QCoreApplication::translate("main", "Baud rate for --headless (8N1)."), "rate", "115200");
+    QCommandLineOption listenOption("listen",
+            QCoreApplication::translate("main", "Bridge address for --headless: tcp:[host:]port or unix:path."), "address");
+    parser.addOption(headlessOption);
+    parser.addOption(portOption);
+    parser.addOption(baudOption);
+    parser.addOption(listenOption);
+#ifdef COMPORT_TRACE
+    QCommandLineOption traceOption("trace",
+            QCoreApplication::translate("main", "Record trace and save it to <file> on exit (Chrome trace JSON)."),
+            "file");
+    parser.addOption(traceOption);
+#endif
+    parser.process(*a);
+
+#ifdef COMPORT_TRACE
+    const QString traceFile = parser.value(traceOption);
+    if (!traceFile.isEmpty())
+        Tracer::setEnabled(true);
+#endif
+
+    QScopedPointer<MainWindow> w;
+    if (headless) {
+        bool ok;
+        const qint32 baudRate = parser.value(baudOption).toInt(&ok);
+        if (!ok || baudRate <= 0) {
+            qCritical("Bad --baud value: %s", qPrintable(parser.value(baudOption)));
+            return 1;
+        }
+        if (!startHeadless(a.data(), parser.value(portOption), baudRate, parser.value(listenOption)))
+            return 1;
+    } else {
+        w.reset(new MainWindow);
+        w->show();
+    }
 
-    return a.exec();
+    const int ret = a->exec();
+#ifdef COMPORT_TRACE
+    if (!traceFile.isEmpty() && !Tracer::dump(traceFile))
+        qWarning("Can't write trace to %s", qPrintable(traceFile));
+#endif
+    return ret;
 }
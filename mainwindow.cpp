@@ -1,17 +1,22 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "tracer.h"
 
 #include <QSerialPortInfo>
 #include <QDebug>
+#include <QFileDialog>
 #include <QMessageBox>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
     setDialog(new SettingsDialog),
-    m_serial(new QSerialPort(this))
+    m_serial(new QSerialPort(this)),
+    m_bridge(new PortBridge(this)),
+    m_bridgeLabel(new QLabel(this))
 {
     ui->setupUi(this);
+    ui->statusBar->addPermanentWidget(m_bridgeLabel);
     setDialog->setModal(true);
     ui->lSelectPort->setText(setDialog->settings().name);
     slApply();
@@ -23,11 +28,31 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->rbHex, &QRadioButton::clicked, ui->actHex, &QAction::trigger);
     connect(ui->rbText, &QRadioButton::clicked, ui->actText, &QAction::trigger);
     connect(m_serial, &QSerialPort::readyRead, this, &MainWindow::slReadData);
+    connect(m_bridge, &PortBridge::sigClientData, this, &MainWindow::writeData);
+    connect(m_bridge, &PortBridge::sigClientCountChanged, [=] (int count) {
+        m_bridgeLabel->setText(tr("%1, clients: %2").arg(m_bridge->address()).arg(count));
+    });
     connect(ui->leSend, &QLineEdit::textChanged, this, &MainWindow::slSendComandChange);
     connect(ui->leTimerMsg, &QLineEdit::textChanged, this, &MainWindow::slSendComandChange);
     connect(ui->actHex, &QAction::triggered, this, &MainWindow::slModeChange);
     connect(ui->actText, &QAction::triggered, this, &MainWindow::slModeChange);
-    connect(&m_timer, &QTimer::timeout, [=] () { slSendData(convertToSend(ui->leTimerMsg->text(), ui->rbHex->isChecked())); });
+    connect(&m_timer, &QTimer::timeout, [=] () {
+        TRACE_SPAN("timer timeout");
+        slSendData(convertToSend(ui->leTimerMsg->text(), ui->rbHex->isChecked()));
+    });
+#ifdef COMPORT_TRACE
+    ui->tools->addSeparator();
+    QAction *actTrace = ui->tools->addAction(tr("&Tracing"));
+    actTrace->setCheckable(true);
+    actTrace->setChecked(Tracer::isEnabled());
+    connect(actTrace, &QAction::toggled, [] (bool checked) { Tracer::setEnabled(checked); });
+    connect(ui->tools->addAction(tr("Save t&race...")), &QAction::triggered, [=] () {
+        const QString fileName = QFileDialog::getSaveFileName(this, tr("Save trace"), "trace.json",
+                                                              tr("Chrome trace (*.json)"));
+        if (!fileName.isEmpty() && !Tracer::dump(fileName))
+            QMessageBox::critical(this, tr("Error"), tr("Can't write %1").arg(fileName));
+    });
+#endif
 
     m_msgTimer.restart();
 }
@@ -48,25 +73,64 @@ void MainWindow::slOpenSerialPort()
     m_serial->setParity(p.parity);
     m_serial->setStopBits(p.stopBits);
     m_serial->setFlowControl(p.flowControl);
-    if (m_serial->open(QIODevice::ReadWrite)) {
+    bool opened = m_serial->open(QIODevice::ReadWrite);
+    QString error = m_serial->errorString();
+    QString baudReport;
+#ifdef Q_OS_LINUX
+    // Если драйвер не принял нестандартную скорость, QSerialPort не открывает порт.
+    // Тогда открываем на стандартной и задаём нужную через termios2/BOTHER.
+    if (!QSerialPortInfo::standardBaudRates().contains(p.baudRate)) {
+        bool fallback = false;
+        if (!opened) {
+            m_serial->setBaudRate(QSerialPort::Baud9600);
+            opened = fallback = m_serial->open(QIODevice::ReadWrite);
+        }
+        if (opened) {
+            bool ok;
+            baudReport = SerialTuning::setBaudRate(m_serial, p.baudRate, &ok);
+            if (fallback && !ok) {
+                m_serial->close();
+                opened = false;
+                error = baudReport;
+            }
+        }
+    }
+#endif
+    if (opened) {
         ui->gbTimer->setEnabled(true);
         ui->gbMonitor->setEnabled(true);
         ui->btnConnect->setEnabled(false);
         ui->btnDisconnect->setEnabled(true);
         ui->actConfigure->setEnabled(false);
-        ui->statusBar->showMessage(tr("Connected to %1 : %2, %3, %4, %5, %6")
-                          .arg(p.name).arg(p.stringBaudRate).arg(p.stringDataBits)
-                          .arg(p.stringParity).arg(p.stringStopBits).arg(p.stringFlowControl));
+        QString msg = tr("Connected to %1 : %2, %3, %4, %5, %6")
+                .arg(p.name).arg(p.stringBaudRate).arg(p.stringDataBits)
+                .arg(p.stringParity).arg(p.stringStopBits).arg(p.stringFlowControl);
+        if (!baudReport.isEmpty())
+            msg += QString(" [%1]").arg(baudReport);
+        const QStringList tuning = m_tuning.apply(m_serial, p);
+        if (!tuning.isEmpty())
+            msg += QString(" [%1]").arg(tuning.join("; "));
+        if (p.bridge) {
+            if (m_bridge->listen(p.bridgeAddress))
+                m_bridgeLabel->setText(tr("%1, clients: 0").arg(m_bridge->address()));
+            else
+                msg += tr(" [bridge error: %1]").arg(m_bridge->errorString());
+        }
+        ui->statusBar->showMessage(msg);
     } else {
-        QMessageBox::critical(this, tr("Error"), m_serial->errorString());
+        QMessageBox::critical(this, tr("Error"), error);
         ui->statusBar->showMessage(tr("Open error"));
     }
 }
 
 void MainWindow::slCloseSerialPort()
 {
-    if (m_serial->isOpen())
+    m_bridge->close();
+    m_bridgeLabel->clear();
+    if (m_serial->isOpen()) {
+        m_tuning.restore();
         m_serial->close();
+    }
     ui->gbTimer->setEnabled(false);
     ui->gbMonitor->setEnabled(false);
     ui->btnConnect->setEnabled(true);
@@ -77,17 +141,24 @@ void MainWindow::slCloseSerialPort()
 
 void MainWindow::printMsg(bool isTx, QByteArray data, qint64 time)
 {
-    if (isTx) {
-        ui->pteMonitor->appendHtml(QString("<div style='color:black;'>Tx (size = %1, time = %3ms):<pre>%2</pre></div>")
-                          .arg(data.size())
-                          .arg(convertToPrint(data, ui->rbHex->isChecked()))
-                          .arg(time));
-    } else {
-        ui->pteMonitor->appendHtml(QString("<div style='color:green;'>Rx (size = %1, time = %3ms):<pre>%2</pre></div>")
-                          .arg(data.size())
-                          .arg(convertToPrint(data, ui->rbHex->isChecked()))
-                          .arg(time));
+    TRACE_SPAN("printMsg");
+    QString html;
+    {
+        TRACE_SPAN("printMsg: build html");
+        if (isTx) {
+            html = QString("<div style='color:black;'>Tx (size = %1, time = %3ms):<pre>%2</pre></div>")
+                    .arg(data.size())
+                    .arg(convertToPrint(data, ui->rbHex->isChecked()))
+                    .arg(time);
+        } else {
+            html = QString("<div style='color:green;'>Rx (size = %1, time = %3ms):<pre>%2</pre></div>")
+                    .arg(data.size())
+                    .arg(convertToPrint(data, ui->rbHex->isChecked()))
+                    .arg(time);
+        }
     }
+    TRACE_SPAN("QPlainTextEdit::appendHtml");
+    ui->pteMonitor->appendHtml(html);
 }
 
 void MainWindow::printMsg(HistoryStruct histItem)
@@ -96,20 +167,36 @@ void MainWindow::printMsg(HistoryStruct histItem)
 }
 
 void MainWindow::slSendData(QByteArray data)
+{
+    TRACE_SPAN("slSendData");
+    writeData(data);
+    m_historyTx.removeAll(data);
+    m_historyTx.append(data);
+}
+
+// Данные от клиентов моста идут сюда же, но не попадают в историю ввода (m_historyTx).
+void MainWindow::writeData(QByteArray data)
 {
     auto time = m_msgTimer.restart();
-    m_serial->write(data);
+    {
+        TRACE_SPAN("QSerialPort::write");
+        m_serial->write(data);
+    }
     HistoryStruct item { true, data, time };
     printMsg(item);
     m_historyRxTx.append(item);
-    m_historyTx.removeAll(data);
-    m_historyTx.append(data);
 }
 
 void MainWindow::slReadData()
 {
-    const QByteArray data = m_serial->readAll();
+    TRACE_SPAN("slReadData");
+    QByteArray data;
+    {
+        TRACE_SPAN("QSerialPort::readAll");
+        data = m_serial->readAll();
+    }
     auto time = m_msgTimer.restart();
+    m_bridge->slBroadcast(data);
 
     HistoryStruct item { false, data, time };
     printMsg(item);
@@ -129,6 +216,7 @@ QByteArray MainWindow::convertToSend(QString msg, bool isHex)
 
 QString MainWindow::convertToPrint(QByteArray hex, bool isHex)
 {
+    TRACE_SPAN("convertToPrint");
     if (isHex) {
         return hex.toHex(' ').toUpper().data();
     } else {
@@ -153,6 +241,7 @@ void MainWindow::slModeChange()
         return;
     }
     lastMode = act;
+    TRACE_SPAN("slModeChange: reprint");
     if (act == ui->actHex) {
         ui->rbHex->setChecked(true);
     } else {
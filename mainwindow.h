@@ -2,9 +2,12 @@
 #define MAINWINDOW_H
 
 #include <QElapsedTimer>
+#include <QLabel>
 #include <QMainWindow>
 #include <QTimer>
 #include "settingsdialog.h"
+#include "serialtuning.h"
+#include "portbridge.h"
 
 namespace Ui {
 class MainWindow;
@@ -38,6 +41,7 @@ protected:
     virtual void keyPressEvent(QKeyEvent *event) override;
     void printMsg(bool isTx, QByteArray data, qint64 time);
     void printMsg(HistoryStruct histItem);
+    void writeData(QByteArray data);
     QString convertToPrint(QByteArray hex, bool isHex);
     QByteArray convertToSend(QString msg, bool isHex);
 private:
@@ -45,6 +49,9 @@ private:
     SettingsDialog *setDialog;
     SettingsDialog::Settings m_settings;
     QSerialPort *m_serial;
+    SerialTuning m_tuning;
+    PortBridge *m_bridge;
+    QLabel *m_bridgeLabel;
     int m_indexHistory = 0;
     QVector<HistoryStruct> m_historyRxTx;
     QVector<QByteArray> m_historyTx;
@@ -0,0 +1,196 @@
+#include "portbridge.h"
+#include "tracer.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <qplatformdefs.h>
+
+// Остаток от упавшего процесса: файл-сокет есть, но на нём никто не слушает.
+// Обычные файлы и сокеты живых процессов (например, --headless) не трогаем.
+static bool isStaleSocket(const QString &name)
+{
+#ifdef Q_OS_UNIX
+    const QString path = QDir::isAbsolutePath(name) ? name : QDir(QDir::tempPath()).absoluteFilePath(name);
+    QT_STATBUF st;
+    if (QT_LSTAT(QFile::encodeName(path).constData(), &st) != 0 || !S_ISSOCK(st.st_mode))
+        return false;
+    QLocalSocket probe;
+    probe.connectToServer(path);
+    return !probe.waitForConnected(500) && probe.error() == QLocalSocket::ConnectionRefusedError;
+#else
+    Q_UNUSED(name);
+    return false;
+#endif
+}
+
+PortBridge::PortBridge(QObject *parent) : QObject(parent)
+{
+}
+
+PortBridge::~PortBridge()
+{
+    blockSignals(true);
+    close();
+}
+
+bool PortBridge::listen(const QString &address)
+{
+    close();
+    m_errorString.clear();
+
+    if (address.startsWith("tcp:")) {
+        const QString hostPort = address.mid(4);
+        const int colon = hostPort.lastIndexOf(':');
+        QHostAddress host = QHostAddress::LocalHost;
+        if (colon >= 0 && !host.setAddress(hostPort.left(colon))) {
+            m_errorString = tr("Bad host in %1").arg(address);
+            return false;
+        }
+        bool ok;
+        const int port = hostPort.mid(colon + 1).toInt(&ok);
+        if (!ok || port < 0 || port > 65535) {
+            m_errorString = tr("Bad port in %1").arg(address);
+            return false;
+        }
+        m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection, this, &PortBridge::slNewTcpConnection);
+        if (!m_tcpServer->listen(host, static_cast<quint16>(port))) {
+            m_errorString = m_tcpServer->errorString();
+            close();
+            return false;
+        }
+    } else if (address.startsWith("unix:")) {
+        const QString name = address.mid(5);
+        m_localServer = new QLocalServer(this);
+        connect(m_localServer, &QLocalServer::newConnection, this, &PortBridge::slNewLocalConnection);
+        bool listening = m_localServer->listen(name);
+        if (!listening && m_localServer->serverError() == QAbstractSocket::AddressInUseError
+                && isStaleSocket(name)) {
+            QLocalServer::removeServer(name);
+            listening = m_localServer->listen(name);
+        }
+        if (!listening) {
+            m_errorString = m_localServer->errorString();
+            close();
+            return false;
+        }
+    } else {
+        m_errorString = tr("Unknown address %1, expected tcp:[host:]port or unix:path").arg(address);
+        return false;
+    }
+    return true;
+}
+
+void PortBridge::close()
+{
+    while (!m_clients.isEmpty())
+        removeClient(m_clients.first()->socket);
+    delete m_tcpServer;
+    m_tcpServer = nullptr;
+    delete m_localServer;
+    m_localServer = nullptr;
+}
+
+QString PortBridge::address() const
+{
+    if (m_tcpServer)
+        return QString("tcp:%1:%2").arg(m_tcpServer->serverAddress().toString()).arg(m_tcpServer->serverPort());
+    if (m_localServer)
+        return QString("unix:%1").arg(m_localServer->fullServerName());
+    return QString();
+}
+
+QString PortBridge::errorString() const
+{
+    return m_errorString;
+}
+
+void PortBridge::slBroadcast(const QByteArray &data)
+{
+    TRACE_SPAN("PortBridge::slBroadcast");
+    if (data.isEmpty())
+        return;
+    // Копируем список: медленный клиент удаляется прямо в цикле.
+    const QList<Client *> clients = m_clients;
+    for (Client *client : clients) {
+        if (client->queued + data.size() > maxQueued) {
+            qWarning() << "PortBridge: client too slow, disconnecting";
+            removeClient(client->socket);
+            continue;
+        }
+        client->queue.enqueue(data);
+        client->queued += data.size();
+        flush(client);
+    }
+}
+
+void PortBridge::slNewTcpConnection()
+{
+    while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, &QTcpSocket::disconnected, this, [=] () { removeClient(socket); });
+        addClient(socket);
+    }
+}
+
+void PortBridge::slNewLocalConnection()
+{
+    while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, this, [=] () { removeClient(socket); });
+        addClient(socket);
+    }
+}
+
+void PortBridge::addClient(QIODevice *socket)
+{
+    Client *client = new Client { socket, QQueue<QByteArray>(), 0 };
+    m_clients.append(client);
+    connect(socket, &QIODevice::readyRead, this, [=] () {
+        TRACE_SPAN("PortBridge: client read");
+        emit sigClientData(socket->readAll());
+    });
+    connect(socket, &QIODevice::bytesWritten, this, [=] () {
+        if (Client *c = findClient(socket))
+            flush(c);
+    });
+    emit sigClientCountChanged(m_clients.size());
+}
+
+void PortBridge::removeClient(QIODevice *socket)
+{
+    Client *client = findClient(socket);
+    if (!client)
+        return;
+    m_clients.removeOne(client);
+    delete client;
+    socket->disconnect(this);
+    socket->close();
+    socket->deleteLater();
+    emit sigClientCountChanged(m_clients.size());
+}
+
+PortBridge::Client *PortBridge::findClient(QIODevice *socket)
+{
+    for (Client *client : m_clients) {
+        if (client->socket == socket)
+            return client;
+    }
+    return nullptr;
+}
+
+void PortBridge::flush(Client *client)
+{
+    // В буфер сокета отдаём не больше socketWatermark, остальное ждёт
+    // в очереди разделяемых буферов до сигнала bytesWritten.
+    while (!client->queue.isEmpty() && client->socket->bytesToWrite() < socketWatermark) {
+        const QByteArray chunk = client->queue.dequeue();
+        client->queued -= chunk.size();
+        client->socket->write(chunk);
+    }
+}
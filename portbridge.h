@@ -0,0 +1,64 @@
+#ifndef PORTBRIDGE_H
+#define PORTBRIDGE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+// Раздаёт поток открытого порта клиентам локального TCP или Unix-сокета.
+// Каждый принятый кусок кладётся в очереди клиентов как один разделяемый
+// QByteArray (без копии на клиента). Данные от клиентов уходят в sigClientData.
+// Клиент, чья очередь переполнилась, отключается, чтобы не тормозить остальных.
+class PortBridge : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PortBridge(QObject *parent = nullptr);
+    ~PortBridge() override;
+
+    // "tcp:5555", "tcp:0.0.0.0:5555" или "unix:/tmp/comport.sock"
+    bool listen(const QString &address);
+    void close();
+    // Адрес, на котором реально слушаем (для tcp:0 — с выданным портом), или пустая строка.
+    QString address() const;
+    QString errorString() const;
+
+signals:
+    void sigClientData(QByteArray data);
+    void sigClientCountChanged(int count);
+
+public slots:
+    void slBroadcast(const QByteArray &data);
+
+private slots:
+    void slNewTcpConnection();
+    void slNewLocalConnection();
+
+private:
+    struct Client
+    {
+        QIODevice *socket;
+        QQueue<QByteArray> queue;
+        qint64 queued;
+    };
+    void addClient(QIODevice *socket);
+    void removeClient(QIODevice *socket);
+    Client *findClient(QIODevice *socket);
+    void flush(Client *client);
+
+    // Сколько держим в буфере сокета и сколько всего может ждать в очереди.
+    static const qint64 socketWatermark = 64 * 1024;
+    static const qint64 maxQueued = 4 * 1024 * 1024;
+
+    QTcpServer *m_tcpServer = nullptr;
+    QLocalServer *m_localServer = nullptr;
+    QList<Client *> m_clients;
+    QString m_errorString;
+};
+
+#endif // PORTBRIDGE_H
@@ -0,0 +1,198 @@
+#include "serialtuning.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSerialPort>
+#include <QSerialPortInfo>
+
+#ifdef Q_OS_LINUX
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+struct SerialTuning::SavedState
+{
+    QString latencyTimerPath;
+    QByteArray latencyTimer;
+#ifdef Q_OS_LINUX
+    int fd = -1;
+    bool termiosSaved = false;
+    bool serialSaved = false;
+    struct termios2 tio;
+    struct serial_struct serial;
+#endif
+};
+
+SerialTuning::SerialTuning()
+{
+}
+
+SerialTuning::~SerialTuning()
+{
+    restore();
+}
+
+#ifdef Q_OS_LINUX
+
+static QString errnoString()
+{
+    return QString::fromLocal8Bit(strerror(errno));
+}
+
+QStringList SerialTuning::apply(QSerialPort *port, const SettingsDialog::Settings &s)
+{
+    QStringList report;
+    restore();
+    if (!s.lowLatency || !port->isOpen())
+        return report;
+
+    m_saved.reset(new SavedState);
+    const int fd = static_cast<int>(port->handle());
+    m_saved->fd = fd;
+
+    // FTDI и другие usb-serial буферизуют приём до latency_timer мс (по умолчанию 16).
+    // При ASYNC_LOW_LATENCY ftdi_sio работает с 1 мс и показывает 1 в sysfs, а запись
+    // в latency_timer лишь запоминается, поэтому флаг — отдельная опция, и пока он
+    // стоит, latency_timer не трогаем. Флаг могли поставить до нас (udev, прошлый
+    // запуск), поэтому сначала приводим его к выбранному состоянию (restore() вернёт
+    // исходное) и только потом читаем настоящее значение таймера.
+    bool lowLatencyFlag = false;
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        m_saved->serial = serial;
+        m_saved->serialSaved = true;
+        if (bool(serial.flags & ASYNC_LOW_LATENCY) != s.asyncLowLatency) {
+            if (s.asyncLowLatency)
+                serial.flags |= ASYNC_LOW_LATENCY;
+            else
+                serial.flags &= ~ASYNC_LOW_LATENCY;
+            if (ioctl(fd, TIOCSSERIAL, &serial) != 0 || ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+                report << tr("ASYNC_LOW_LATENCY: %1").arg(errnoString());
+                serial = m_saved->serial;
+            }
+        }
+        lowLatencyFlag = serial.flags & ASYNC_LOW_LATENCY;
+        report << tr("ASYNC_LOW_LATENCY: %1").arg(lowLatencyFlag ? tr("on") : tr("off"));
+    } else if (s.asyncLowLatency) {
+        report << tr("ASYNC_LOW_LATENCY: %1").arg(errnoString());
+    }
+
+    const QString tty = QFileInfo(QFileInfo(QSerialPortInfo(*port).systemLocation()).canonicalFilePath()).fileName();
+    QFile latency(QString("/sys/class/tty/%1/device/latency_timer").arg(tty));
+    QByteArray oldLatency;
+    if (!lowLatencyFlag && latency.exists() && latency.open(QIODevice::ReadOnly)) {
+        oldLatency = latency.readAll().trimmed();
+        latency.close();
+    }
+
+    if (!latency.exists()) {
+        report << tr("latency_timer: n/a");
+    } else if (lowLatencyFlag) {
+        QByteArray current;
+        if (latency.open(QIODevice::ReadOnly))
+            current = latency.readAll().trimmed();
+        report << tr("latency_timer: %1 ms (ASYNC_LOW_LATENCY)").arg(QString(current));
+    } else if (oldLatency.isEmpty()) {
+        report << tr("latency_timer: %1").arg(latency.errorString());
+    } else if (latency.open(QIODevice::WriteOnly | QIODevice::Unbuffered)
+               && latency.write(QByteArray::number(s.latencyTimer)) > 0) {
+        m_saved->latencyTimerPath = latency.fileName();
+        m_saved->latencyTimer = oldLatency;
+        latency.close();
+        QByteArray current;
+        if (latency.open(QIODevice::ReadOnly))
+            current = latency.readAll().trimmed();
+        report << tr("latency_timer: %1 -> %2 ms").arg(QString(oldLatency)).arg(QString(current));
+    } else {
+        report << tr("latency_timer: %1").arg(latency.errorString());
+    }
+
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0) {
+        report << tr("termios2: %1").arg(errnoString());
+        return report;
+    }
+    m_saved->tio = tio;
+    m_saved->termiosSaved = true;
+
+    // VMIN/VTIME влияют только на блокирующий read(). QSerialPort читает
+    // неблокирующе, а дескриптор больше никому не доступен, так что на приём
+    // в этом приложении они не влияют; в отчёте это сказано явно.
+    tio.c_cc[VMIN] = static_cast<cc_t>(s.vmin);
+    tio.c_cc[VTIME] = static_cast<cc_t>(s.vtime);
+    if (ioctl(fd, TCSETS2, &tio) != 0 || ioctl(fd, TCGETS2, &tio) != 0) {
+        report << tr("termios2: %1").arg(errnoString());
+        return report;
+    }
+    report << tr("VMIN = %1, VTIME = %2 (no effect on non-blocking reads)").arg(tio.c_cc[VMIN]).arg(tio.c_cc[VTIME]);
+    return report;
+}
+
+QString SerialTuning::setBaudRate(QSerialPort *port, qint32 baudRate, bool *ok)
+{
+    // Драйверы вроде pl2303 округляют BOTHER до ближайшего делителя и сообщают
+    // полученную скорость. Расхождение до 2% UART переносит, такое принимаем.
+    const qint64 tolerance = baudRate / 50;
+    *ok = false;
+    const int fd = static_cast<int>(port->handle());
+    struct termios2 tio;
+    if (ioctl(fd, TCGETS2, &tio) != 0)
+        return tr("Can't read baud rate: %1").arg(errnoString());
+    if (tio.c_ospeed == static_cast<speed_t>(baudRate)) {
+        *ok = true;
+        return QString();
+    }
+    tio.c_cflag &= ~CBAUD;
+    tio.c_cflag |= BOTHER;
+    tio.c_ispeed = tio.c_ospeed = static_cast<speed_t>(baudRate);
+    if (ioctl(fd, TCSETS2, &tio) != 0 || ioctl(fd, TCGETS2, &tio) != 0)
+        return tr("Baud rate %1 was not accepted: %2").arg(baudRate).arg(errnoString());
+    if (qAbs(static_cast<qint64>(tio.c_ospeed) - baudRate) > tolerance)
+        return tr("Baud rate %1 was not accepted, driver set %2").arg(baudRate).arg(tio.c_ospeed);
+    *ok = true;
+    return tr("baud: %1 (BOTHER, requested %2)").arg(tio.c_ospeed).arg(baudRate);
+}
+
+void SerialTuning::restore()
+{
+    if (!m_saved)
+        return;
+    if (m_saved->termiosSaved)
+        ioctl(m_saved->fd, TCSETS2, &m_saved->tio);
+    // Сначала флаги: от ASYNC_LOW_LATENCY в ftdi_sio зависит, какой таймер действует.
+    if (m_saved->serialSaved)
+        ioctl(m_saved->fd, TIOCSSERIAL, &m_saved->serial);
+    if (!m_saved->latencyTimerPath.isEmpty()) {
+        QFile latency(m_saved->latencyTimerPath);
+        if (latency.open(QIODevice::WriteOnly))
+            latency.write(m_saved->latencyTimer);
+    }
+    m_saved.reset();
+}
+
+#else
+
+QStringList SerialTuning::apply(QSerialPort *port, const SettingsDialog::Settings &s)
+{
+    Q_UNUSED(port);
+    if (!s.lowLatency)
+        return QStringList();
+    return QStringList() << tr("low latency: not supported on this platform");
+}
+
+QString SerialTuning::setBaudRate(QSerialPort *port, qint32 baudRate, bool *ok)
+{
+    Q_UNUSED(port);
+    Q_UNUSED(baudRate);
+    *ok = false;
+    return tr("BOTHER: not supported on this platform");
+}
+
+void SerialTuning::restore()
+{
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SERIALTUNING_H
+#define SERIALTUNING_H
+
+#include <QCoreApplication>
+#include <QScopedPointer>
+#include <QStringList>
+#include "settingsdialog.h"
+
+class QSerialPort;
+
+// Низколатентная настройка открытого порта (только Linux): FTDI latency_timer,
+// ASYNC_LOW_LATENCY и VMIN/VTIME. apply() запоминает исходное состояние,
+// restore() возвращает его перед закрытием.
+class SerialTuning
+{
+    Q_DECLARE_TR_FUNCTIONS(SerialTuning)
+
+public:
+    SerialTuning();
+    ~SerialTuning();
+
+    // Возвращает отчёт о том, что удалось применить на самом деле.
+    QStringList apply(QSerialPort *port, const SettingsDialog::Settings &s);
+    void restore();
+
+    // Нестандартная скорость через termios2/BOTHER, независимо от low latency.
+    // Ничего не делает, если драйвер уже выставил baudRate. Иначе *ok = true, если
+    // полученная скорость отличается не больше чем на 2%, и возвращается отчёт
+    // о ней; при *ok = false возвращается текст ошибки.
+    static QString setBaudRate(QSerialPort *port, qint32 baudRate, bool *ok);
+
+private:
+    // termios2 и serial_struct нельзя объявить здесь: <asm/termbits.h>
+    // конфликтует с <termios.h>, поэтому состояние живёт в serialtuning.cpp.
+    struct SavedState;
+    QScopedPointer<SavedState> m_saved;
+};
+
+#endif // SERIALTUNING_H
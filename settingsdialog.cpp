@@ -77,6 +77,12 @@ SettingsDialog::SettingsDialog(QWidget *parent) :
             this, &SettingsDialog::checkCustomDevicePathPolicy);
     connect(m_ui->btnSearch, &QPushButton::clicked,
             this, &SettingsDialog::fillPortsInfo);
+    connect(m_ui->asyncLowLatencyBox, &QCheckBox::toggled,
+            m_ui->latencyTimerBox, &QSpinBox::setDisabled);
+
+#ifndef Q_OS_LINUX
+    m_ui->lowLatencyBox->hide();
+#endif
 
     fillPortsParameters();
     fillPortsInfo();
@@ -218,4 +224,13 @@ void SettingsDialog::updateSettings()
     m_currentSettings.flowControl = static_cast<QSerialPort::FlowControl>(
                 m_ui->flowControlBox->itemData(m_ui->flowControlBox->currentIndex()).toInt());
     m_currentSettings.stringFlowControl = m_ui->flowControlBox->currentText();
+
+    m_currentSettings.lowLatency = m_ui->lowLatencyBox->isChecked();
+    m_currentSettings.asyncLowLatency = m_ui->asyncLowLatencyBox->isChecked();
+    m_currentSettings.latencyTimer = m_ui->latencyTimerBox->value();
+    m_currentSettings.vmin = m_ui->vminBox->value();
+    m_currentSettings.vtime = m_ui->vtimeBox->value();
+
+    m_currentSettings.bridge = m_ui->bridgeBox->isChecked();
+    m_currentSettings.bridgeAddress = m_ui->bridgeAddressEdit->text().trimmed();
 }
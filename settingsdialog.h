@@ -82,6 +82,13 @@ public:
         QString stringStopBits;
         QSerialPort::FlowControl flowControl;
         QString stringFlowControl;
+        bool lowLatency;
+        bool asyncLowLatency;
+        int latencyTimer;
+        int vmin;
+        int vtime;
+        bool bridge;
+        QString bridgeAddress;
     };
 
     explicit SettingsDialog(QWidget *parent = nullptr);
@@ -0,0 +1,115 @@
+#include "tracer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <chrono>
+
+namespace {
+
+const quint32 traceCapacity = 1u << 16;   // степень двойки
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 begin;
+    qint64 end;
+};
+
+// Кольцевой буфер одного потока: пишет только владелец, dump() лишь читает,
+// поэтому запись обходится без блокировок.
+struct ThreadBuffer
+{
+    quintptr tid = 0;
+    std::atomic<quint32> head { 0 };
+    TraceEvent events[traceCapacity];
+};
+
+// Реестр буферов нужен только при первом событии потока и при dump().
+// Буферы не удаляются: события завершившихся потоков тоже попадают в дамп.
+QMutex registryMutex;
+QVector<ThreadBuffer *> registry;
+
+thread_local ThreadBuffer *t_buffer = nullptr;
+
+ThreadBuffer *threadBuffer()
+{
+    if (!t_buffer) {
+        t_buffer = new ThreadBuffer;
+        t_buffer->tid = reinterpret_cast<quintptr>(QThread::currentThreadId());
+        QMutexLocker locker(&registryMutex);
+        registry.append(t_buffer);
+    }
+    return t_buffer;
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_enabled { false };
+
+void Tracer::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Tracer::now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::record(const char *name, qint64 begin, qint64 end)
+{
+    ThreadBuffer *buf = threadBuffer();
+    const quint32 idx = buf->head.load(std::memory_order_relaxed);
+    buf->events[idx & (traceCapacity - 1)] = { name, begin, end };
+    buf->head.store(idx + 1, std::memory_order_release);
+}
+
+bool Tracer::dump(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QVector<ThreadBuffer *> buffers;
+    {
+        QMutexLocker locker(&registryMutex);
+        buffers = registry;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (ThreadBuffer *buf : buffers) {
+        const quint32 head = buf->head.load(std::memory_order_acquire);
+        const quint32 count = qMin(head, traceCapacity);
+        QVector<TraceEvent> events;
+        events.reserve(static_cast<int>(count));
+        for (quint32 i = head - count; i != head; ++i)
+            events.append(buf->events[i & (traceCapacity - 1)]);
+        // Пока копировали, поток мог перезаписать самые старые ячейки — отбрасываем их.
+        const quint32 newHead = buf->head.load(std::memory_order_acquire);
+        const quint32 overwritten = qMin(newHead - head, count);
+
+        for (int i = static_cast<int>(overwritten); i < events.size(); ++i) {
+            const TraceEvent &e = events.at(i);
+            if (!first)
+                out << ',';
+            first = false;
+            out << "\n{\"name\":\"" << e.name
+                << "\",\"ph\":\"X\",\"ts\":" << e.begin
+                << ",\"dur\":" << (e.end - e.begin)
+                << ",\"pid\":" << pid
+                << ",\"tid\":" << buf->tid << '}';
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
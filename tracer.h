@@ -0,0 +1,59 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+// Трассировка горячих путей в формате Chrome trace (chrome://tracing, Perfetto).
+// Включается при сборке: qmake CONFIG+=trace. Без этого TRACE_SPAN ничего не делает.
+
+#ifdef COMPORT_TRACE
+
+#include <QString>
+#include <atomic>
+
+class Tracer
+{
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // Записывает все накопленные события в fileName (Chrome trace JSON).
+    static bool dump(const QString &fileName);
+    // Микросекунды монотонных часов.
+    static qint64 now();
+    static void record(const char *name, qint64 begin, qint64 end);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(Tracer::isEnabled() ? name : nullptr),
+          m_begin(m_name ? Tracer::now() : 0)
+    {
+    }
+    ~TraceSpan()
+    {
+        if (m_name)
+            Tracer::record(m_name, m_begin, Tracer::now());
+    }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_begin;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+// name должно быть строковым литералом: хранится только указатель.
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+#else
+
+#define TRACE_SPAN(name) ((void)0)
+
+#endif // COMPORT_TRACE
+
+#endif // TRACER_H